@@ -0,0 +1,430 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "wadgen.hpp"
+#include "wadfile.hpp"
+#include "common.hpp"
+#include "color.hpp"
+#include "picture.hpp"
+#include "sound.hpp"
+
+namespace {
+
+std::atomic<std::size_t> alloc_count(0);
+std::atomic<std::size_t> alloc_bytes(0);
+
+}
+
+// Count every allocation, so that regressions in the number of them show up
+void *operator new(std::size_t size) {
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+// What a single iteration got through
+struct Work {
+    std::size_t bytes;
+    std::size_t ops;
+};
+
+struct LumpRef {
+    std::size_t dir;
+    std::size_t index;
+};
+
+// One line per benchmark, with the keys always in the same order
+void run(const std::string &name, int iterations, const std::function<Work()> &func) {
+    std::vector<std::int64_t> times;
+    std::size_t allocs = 0, bytes_allocated = 0;
+    Work work = {0, 0};
+
+    for (int i = 0; i < iterations; i++) {
+        auto count = alloc_count.load();
+        auto bytes = alloc_bytes.load();
+        auto start = std::chrono::steady_clock::now();
+
+        work = func();
+
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+        allocs += alloc_count.load() - count;
+        bytes_allocated += alloc_bytes.load() - bytes;
+    }
+
+    // The median is less noisy than the mean
+    std::sort(times.begin(), times.end());
+    auto ns = std::max<std::int64_t>(times[times.size() / 2], 1);
+    double seconds = ns / 1e9;
+
+    char line[512];
+    std::snprintf(line, sizeof(line),
+        "name=%s iterations=%d ns=%lld bytes=%zu ops=%zu mb_per_s=%.2f ops_per_s=%.2f allocs=%zu alloc_bytes=%zu",
+        name.c_str(), iterations, static_cast<long long>(ns), work.bytes, work.ops,
+        work.bytes / seconds / (1024.0 * 1024.0), work.ops / seconds,
+        allocs / iterations, bytes_allocated / iterations
+    );
+
+    std::cout << line << std::endl;
+}
+
+void collect_lumps(const WadFile &wad, std::size_t dir_index, std::vector<LumpRef> &refs) {
+    const auto &dir = wad.get_dir(dir_index);
+
+    for (auto i : dir.lumps)
+        refs.push_back({dir_index, i});
+
+    for (auto i : dir.dirs)
+        collect_lumps(wad, i, refs);
+}
+
+Work read_lumps(WadFile &wad, const std::vector<LumpRef> &refs) {
+    Work work = {0, 0};
+
+    for (const auto &ref : refs) {
+        work.bytes += wad.read_lump(ref.dir, ref.index)->size();
+        work.ops++;
+    }
+
+    return work;
+}
+
+// Same as unwad
+void extract_dir(const std::string &base_path, WadFile &wad, std::size_t dir_index, Work &work) {
+    auto dir = wad.get_dir(dir_index);
+    auto dir_name = dir.name;
+
+    if (dir_name.size()) {
+        std::filesystem::create_directories(std::filesystem::path(base_path + dir_name));
+        dir_name += "/";
+    }
+
+    for (auto i : dir.lumps) {
+        auto lump = wad.read_lump(dir_index, i);
+
+        std::fstream file(base_path + dir_name + wad.lump_name(i), std::ios::out | std::ios::binary);
+        if (!file.good())
+            throw std::runtime_error("Unable to create file " + wad.lump_name(i));
+
+        lump->write(file);
+        work.bytes += lump->size();
+        work.ops++;
+    }
+
+    for (auto i : dir.dirs)
+        extract_dir(base_path + dir_name, wad, i, work);
+}
+
+// Decodes a patch or sound through its typed class, returning the decoded size (0 when it isn't valid)
+std::size_t decode(const Lump &lump, Palette &pal) {
+    if (auto picture = dynamic_cast<const Picture*>(&lump)) {
+        if (!picture->valid())
+            return 0;
+
+        picture->to_image(pal);
+        return picture->width() * picture->height() * sizeof(Color);
+    }
+
+    if (auto sound = dynamic_cast<const Sound*>(&lump))
+        return sound->valid() ? sound->sample_count() : 0;
+
+    return 0;
+}
+
+// Removes the work directory however the run ends
+struct WorkDir {
+    std::filesystem::path path;
+
+    WorkDir() {
+        auto temp = std::filesystem::temp_directory_path();
+        std::random_device random;
+
+        // create_directory is false when it already exists, so another run never shares it
+        do {
+            char name[32];
+            std::snprintf(name, sizeof(name), "wadbench-%08x", static_cast<unsigned>(random()));
+            path = temp / name;
+        } while (!std::filesystem::create_directory(path));
+    }
+
+    ~WorkDir() {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+
+    WorkDir(const WorkDir &) = delete;
+    WorkDir &operator=(const WorkDir &) = delete;
+};
+
+void usage(const char *name) {
+    std::cout << "Usage: " << name << " [-n ITERATIONS] [-s SEED] [-o WAD PATH] [GENERATOR OPTIONS]" << std::endl;
+    std::cout << "  -o only generates the synthetic WAD" << std::endl;
+    std::cout << "Generator options:" << std::endl;
+    std::cout << "  --lumps N       Plain lumps (Default 1024)" << std::endl;
+    std::cout << "  --min-size N    Smallest lump size (Default 16)" << std::endl;
+    std::cout << "  --max-size N    Largest lump size (Default 65536)" << std::endl;
+    std::cout << "  --namespaces N  Top-level namespaces, up to 6 (Default 3)" << std::endl;
+    std::cout << "  --depth N       Nested namespaces inside each, up to 9 (Default 2)" << std::endl;
+    std::cout << "  --maps N        ExMy map groups, up to 81 (Default 8)" << std::endl;
+    std::cout << "  --doom2-maps N  MAPxx map groups, up to 99 (Default 8)" << std::endl;
+    std::cout << "  --flats N       64x64 flats (Default 64)" << std::endl;
+    std::cout << "  --pictures N    Patches (Default 64)" << std::endl;
+    std::cout << "  --sounds N      Sound effects (Default 32)" << std::endl;
+}
+
+}
+
+int main(int argc, char **argv) {
+    int iterations = 10;
+    WadGen::Config config;
+    std::string output;
+
+    const std::pair<const char*, std::size_t*> sizes[] = {
+        {"--lumps",      &config.lumps},
+        {"--min-size",   &config.min_size},
+        {"--max-size",   &config.max_size},
+        {"--namespaces", &config.namespaces},
+        {"--depth",      &config.depth},
+        {"--maps",       &config.maps},
+        {"--doom2-maps", &config.doom2_maps},
+        {"--flats",      &config.flats},
+        {"--pictures",   &config.pictures},
+        {"--sounds",     &config.sounds},
+    };
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        auto size = std::find_if(std::begin(sizes), std::end(sizes), [&](const auto &s) { return arg == s.first; });
+
+        if (arg == "-n")
+            iterations = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "-s")
+            config.seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "-o")
+            output = argv[++i];
+        else if (size != std::end(sizes))
+            *size->second = std::strtoull(argv[++i], nullptr, 10);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        if (output.size()) {
+            WadGen::generate(output, config);
+            return 0;
+        }
+
+        WorkDir work;
+        const auto &work_dir = work.path;
+
+        auto wad_path = (work_dir / "synthetic.wad").string();
+        WadGen::generate(wad_path, config);
+
+        // Lots of tiny lumps, to weigh directory parsing over reading
+        auto dir_config = config;
+        dir_config.lumps      = 100000;
+        dir_config.min_size   = 1;
+        dir_config.max_size   = 16;
+        dir_config.depth      = 9;
+        dir_config.maps       = 81;
+        dir_config.doom2_maps = 99;
+        dir_config.flats      = 0;
+        dir_config.pictures   = 0;
+        dir_config.sounds     = 0;
+
+        auto dir_path = (work_dir / "directory.wad").string();
+        WadGen::generate(dir_path, dir_config);
+
+        run("open", iterations, [&] {
+            WadFile wad(wad_path, WadFile::Open);
+            return Work{0, 1};
+        });
+
+        std::size_t dir_entries;
+        {
+            WadFile wad(dir_path, WadFile::Open);
+            std::vector<LumpRef> refs;
+            collect_lumps(wad, 0, refs);
+            dir_entries = refs.size();
+        }
+
+        run("directory", iterations, [&] {
+            WadFile wad(dir_path, WadFile::Open);
+            return Work{0, dir_entries};
+        });
+
+        WadFile wad(wad_path, WadFile::Open);
+
+        // In file order
+        std::vector<LumpRef> refs;
+        collect_lumps(wad, 0, refs);
+        std::sort(refs.begin(), refs.end(), [](const LumpRef &a, const LumpRef &b) { return a.index < b.index; });
+
+        run("read_sequential", iterations, [&] {
+            return read_lumps(wad, refs);
+        });
+
+        // Shuffled by hand, std::shuffle differs between implementations
+        std::mt19937 rng(config.seed);
+        for (std::size_t i = refs.size(); i > 1; i--)
+            std::swap(refs[i-1], refs[rng() % i]);
+
+        run("read_random", iterations, [&] {
+            return read_lumps(wad, refs);
+        });
+
+        auto extract_path = (work_dir / "extract").string() + "/";
+        std::filesystem::create_directories(extract_path);
+
+        run("extract", iterations, [&] {
+            Work work = {0, 0};
+            extract_dir(extract_path, wad, 0, work);
+            return work;
+        });
+
+        // Convert the flats through the palette
+        std::unique_ptr<Palette> pal;
+        std::vector<LumpRef> flats;
+
+        for (auto i : wad.root_dir().lumps) {
+            if (wad.lump_name(i) == "PLAYPAL")
+                pal.reset(dynamic_cast<Palette*>(wad.read_lump(0, i).release()));
+        }
+
+        for (auto d : wad.root_dir().dirs) {
+            if (wad.get_dir(d).name != "F")
+                continue;
+
+            for (auto i : wad.get_dir(d).lumps) {
+                if (wad.lump_size(i) == 64 * 64)
+                    flats.push_back({d, i});
+            }
+        }
+
+        if (!pal)
+            throw std::runtime_error("No palette in the synthetic WAD");
+
+        auto image_path = [&](std::size_t index) {
+            return (work_dir / (std::to_string(index) + ".png")).string();
+        };
+
+        run("image_save", iterations, [&] {
+            Work work = {0, 0};
+            auto image = std::make_unique<Color[]>(64 * 64);
+
+            for (std::size_t i = 0; i < flats.size(); i++) {
+                auto lump = wad.read_lump(flats[i].dir, flats[i].index);
+
+                for (std::size_t p = 0; p < 64 * 64; p++)
+                    image[p] = (*pal)[lump->data()[p]];
+
+                if (!Common::save_image(image_path(i), image.get(), 64, 64))
+                    throw std::runtime_error("Unable to save " + image_path(i));
+
+                work.bytes += 64 * 64 * sizeof(Color);
+                work.ops++;
+            }
+
+            return work;
+        });
+
+        run("image_load", iterations, [&] {
+            Work work = {0, 0};
+
+            for (std::size_t i = 0; i < flats.size(); i++) {
+                auto image = Common::load_image(image_path(i));
+                work.bytes += std::get<1>(image) * std::get<2>(image) * sizeof(Color);
+                work.ops++;
+            }
+
+            return work;
+        });
+
+        // Only the valid patches and sounds, the random lumps that land in P are rejected almost straight away
+        std::vector<LumpRef> decodable;
+        for (const auto &ref : refs) {
+            auto type = wad.lump_type(ref.index);
+            if ((type == LumpType::Picture || type == LumpType::Sound) && decode(*wad.read_lump(ref.dir, ref.index), *pal))
+                decodable.push_back(ref);
+        }
+
+        run("decode", iterations, [&] {
+            Work work = {0, 0};
+
+            // Each read is a new lump, so it decodes again every iteration
+            for (const auto &ref : decodable) {
+                work.bytes += decode(*wad.read_lump(ref.dir, ref.index), *pal);
+                work.ops++;
+            }
+
+            return work;
+        });
+    }
+    catch (const std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
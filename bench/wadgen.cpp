@@ -0,0 +1,219 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "wadgen.hpp"
+#include "wadfile.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Only the raw engine output is used, the std distributions differ between implementations
+std::size_t random_size(std::mt19937 &rng, std::size_t min, std::size_t max) {
+    auto log2 = [](std::size_t n) {
+        unsigned bits = 0;
+        while (n >>= 1)
+            bits++;
+        return bits;
+    };
+
+    // Pick a power of two, then a size within it
+    auto lo = log2(std::max<std::size_t>(min, 1));
+    auto hi = log2(std::max(min, max));
+
+    auto bits = lo + rng() % (hi - lo + 1);
+    std::size_t size = (std::size_t(1) << bits) + rng() % (std::size_t(1) << bits);
+
+    return std::clamp(size, min, std::max(min, max));
+}
+
+Lump random_lump(std::mt19937 &rng, std::size_t size) {
+    // Keep the values small, so the data compresses somewhat like real lumps
+    auto data = std::make_unique<std::uint8_t[]>(size);
+    for (std::size_t i = 0; i < size; i++)
+        data[i] = rng() & 0x3F;
+
+    return Lump(std::move(data), size);
+}
+
+Lump palette_lump() {
+    // 14 palettes of 256 RGB colors
+    const std::size_t size = 14 * 256 * 3;
+
+    auto data = std::make_unique<std::uint8_t[]>(size);
+    for (std::size_t i = 0; i < size; i++)
+        data[i] = (i * 7) & 0xFF;
+
+    return Lump(std::move(data), size);
+}
+
+Lump vector_lump(const std::vector<std::uint8_t> &bytes) {
+    auto data = std::make_unique<std::uint8_t[]>(bytes.size());
+    std::copy(bytes.begin(), bytes.end(), data.get());
+
+    return Lump(std::move(data), bytes.size());
+}
+
+void put16(std::vector<std::uint8_t> &bytes, std::size_t offset, std::uint16_t n) {
+    bytes[offset]   = n & 0xFF;
+    bytes[offset+1] = n >> 8;
+}
+
+void put32(std::vector<std::uint8_t> &bytes, std::size_t offset, std::uint32_t n) {
+    put16(bytes, offset, n & 0xFFFF);
+    put16(bytes, offset+2, n >> 16);
+}
+
+// A patch of up to 64x64, with one or two posts per column and gaps left transparent
+Lump picture_lump(std::mt19937 &rng) {
+    std::size_t width  = 8 + rng() % 57;
+    std::size_t height = 8 + rng() % 57;
+
+    std::vector<std::uint8_t> bytes(8 + width*4);
+    put16(bytes, 0, width);
+    put16(bytes, 2, height);
+    put16(bytes, 4, width / 2);
+    put16(bytes, 6, height);
+
+    for (std::size_t x = 0; x < width; x++) {
+        put32(bytes, 8 + x*4, bytes.size());
+
+        // Each post is the top, the length, a padding byte, the pixels, then another padding byte
+        std::size_t top = rng() % (height / 2);
+        for (int post = 0; post < 2 && top < height; post++) {
+            std::size_t length = 1 + rng() % (height - top);
+
+            bytes.push_back(top);
+            bytes.push_back(length);
+            bytes.push_back(0);
+            for (std::size_t y = 0; y < length; y++)
+                bytes.push_back(rng() & 0xFF);
+            bytes.push_back(0);
+
+            top += length + 1 + rng() % 4;
+        }
+
+        bytes.push_back(0xFF);
+    }
+
+    return vector_lump(bytes);
+}
+
+// Format 3 at 11025Hz, with the 16 padding samples at either end
+Lump sound_lump(std::mt19937 &rng, std::size_t samples) {
+    std::vector<std::uint8_t> bytes(8);
+    put16(bytes, 0, 3);
+    put16(bytes, 2, 11025);
+    put32(bytes, 4, samples + 32);
+
+    bytes.insert(bytes.end(), 16, 0x80);
+    for (std::size_t i = 0; i < samples; i++)
+        bytes.push_back(0x80 + (rng() & 0x3F) - 0x20);
+    bytes.insert(bytes.end(), 16, 0x80);
+
+    return vector_lump(bytes);
+}
+
+std::string lump_name(std::size_t index) {
+    char name[9];
+    std::snprintf(name, sizeof(name), "L%07zu", index % 10000000);
+    return name;
+}
+
+}
+
+namespace WadGen {
+
+void generate(const std::string &path, const Config &config) {
+    static const char *const namespace_names[] = {"S", "P", "F", "SS", "PP", "FF"};
+    static const char *const map_lumps[] = {
+        "THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS",
+        "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP"
+    };
+
+    std::mt19937 rng(config.seed);
+    WadFile wad(path, WadFile::CreatePWAD);
+
+    wad.write_lump(0, "PLAYPAL", palette_lump());
+
+    // Create the namespaces, each with a chain of nested ones (S -> S1 -> S2...)
+    std::vector<std::size_t> dirs = {0};
+    std::size_t flat_dir = 0, patch_dir = 0;
+
+    for (std::size_t i = 0; i < std::min<std::size_t>(config.namespaces, 6); i++) {
+        std::string name = namespace_names[i];
+        auto dir = wad.create_dir(0, name);
+        dirs.push_back(dir);
+
+        if (name == "F")
+            flat_dir = dir;
+        else if (name == "P")
+            patch_dir = dir;
+
+        for (std::size_t level = 1; level <= std::min<std::size_t>(config.depth, 9); level++) {
+            dir = wad.create_dir(dir, name.substr(0, 1) + std::to_string(level));
+            dirs.push_back(dir);
+        }
+    }
+
+    // Spread the plain lumps over all of the directories
+    for (std::size_t i = 0; i < config.lumps; i++) {
+        auto dir = dirs[rng() % dirs.size()];
+        wad.write_lump(dir, lump_name(i), random_lump(rng, random_size(rng, config.min_size, config.max_size)));
+    }
+
+    // Flats are always 64x64
+    if (config.flats && !flat_dir)
+        flat_dir = wad.create_dir(0, "F");
+
+    for (std::size_t i = 0; i < config.flats; i++)
+        wad.write_lump(flat_dir, lump_name(config.lumps + i), random_lump(rng, 64 * 64));
+
+    if (config.pictures && !patch_dir)
+        patch_dir = wad.create_dir(0, "P");
+
+    for (std::size_t i = 0; i < config.pictures; i++)
+        wad.write_lump(patch_dir, lump_name(config.lumps + config.flats + i), picture_lump(rng));
+
+    for (std::size_t i = 0; i < config.sounds; i++) {
+        char name[9];
+        std::snprintf(name, sizeof(name), "DS%06zu", i % 1000000);
+        wad.write_lump(0, name, sound_lump(rng, random_size(rng, config.min_size, config.max_size)));
+    }
+
+    // Map groups (E1M1 to E9M9)
+    for (std::size_t i = 0; i < std::min<std::size_t>(config.maps, 81); i++) {
+        auto dir = wad.create_dir(0, "E" + std::to_string(i/9 + 1) + "M" + std::to_string(i%9 + 1));
+
+        for (auto name : map_lumps)
+            wad.write_lump(dir, name, random_lump(rng, random_size(rng, config.min_size, config.max_size)));
+    }
+
+    // MAP01 to MAP99, which also get the Hexen BEHAVIOR lump
+    for (std::size_t i = 0; i < std::min<std::size_t>(config.doom2_maps, 99); i++) {
+        char name[9];
+        std::snprintf(name, sizeof(name), "MAP%02zu", i + 1);
+        auto dir = wad.create_dir(0, name);
+
+        for (auto name : map_lumps)
+            wad.write_lump(dir, name, random_lump(rng, random_size(rng, config.min_size, config.max_size)));
+
+        wad.write_lump(dir, "BEHAVIOR", random_lump(rng, random_size(rng, config.min_size, config.max_size)));
+    }
+}
+
+};
@@ -0,0 +1,42 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace WadGen {
+
+struct Config {
+    std::uint32_t seed = 1;
+
+    std::size_t lumps    = 1024;      // Plain lumps, spread over the root and the namespaces
+    std::size_t min_size = 16;        // Lump sizes are log-uniform between these
+    std::size_t max_size = 64 * 1024;
+
+    std::size_t namespaces = 3;       // Top-level namespaces (S, P, F...)
+    std::size_t depth      = 2;       // Levels of nesting inside each of them (S1, S2...)
+    std::size_t maps       = 8;       // ExMy map groups, with all 10 map lumps each
+    std::size_t doom2_maps = 8;       // MAPxx map groups, in Hexen format (With BEHAVIOR)
+    std::size_t flats      = 64;      // 64x64 flats in F, for the image conversion
+    std::size_t pictures   = 64;      // Valid patches in P, for the decoders
+    std::size_t sounds     = 32;      // DMX sound effects (DSxxxxxx) at the root
+};
+
+// The same config always produces the same file, on every platform
+void generate(const std::string &path, const Config &config);
+
+};
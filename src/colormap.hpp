@@ -0,0 +1,43 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cassert>
+
+#include "lump.hpp"
+
+class ColorMap : public Lump
+{
+public:
+    ColorMap() : Lump() {
+    }
+
+    ColorMap(std::istream &file, std::size_t size) : Lump(file, size) {
+    }
+
+    ColorMap(const std::string &path) : Lump(path) {
+    }
+
+    // Light levels, then the invulnerability map
+    std::size_t count() const {
+        return size_ / 256;
+    }
+
+    std::uint8_t operator () (std::size_t map, std::size_t index) const {
+        assert(map < count() && index < 256);
+        return data_[map*256 + index];
+    }
+};
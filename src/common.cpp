@@ -1,5 +1,8 @@
 #include "common.hpp"
 #include "color.hpp"
+#include "stats.hpp"
+#include <array>
+#include <filesystem>
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -10,21 +13,80 @@
 namespace Common {
 
 bool save_image(const std::string &path, const Color *image, unsigned int width, unsigned int height) {
+    Stats::Timer timer(Stats::SaveImage);
+
     int result = stbi_write_png(path.c_str(), width, height, 4, image, width*4);
+
+    if (Stats::active && result) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        Stats::add_written(error ? 0 : size);
+    }
+
     return result != 0;
 }
 
 std::tuple<std::unique_ptr<Color[]>, int, int> load_image(const std::string &path) {
+    Stats::Timer timer(Stats::LoadImage);
+
+    if (Stats::active) {
+        std::error_code error;
+        auto size = std::filesystem::file_size(path, error);
+        Stats::add_read(error ? 0 : size);
+    }
+
     // Load the image
     int x, y, n = 4;
     auto pixels = stbi_load(path.c_str(), &x, &y, &n, n);
 
     // Copy the data
     auto data = std::make_unique<Color[]>(x * y);
+    Stats::add_alloc(x * y * sizeof(Color));
     std::copy(pixels, pixels + x*y*n, reinterpret_cast<char*>(data.get()));
     stbi_image_free(pixels);
 
     return std::make_tuple(std::move(data), x, y);
 }
 
+std::vector<std::uint8_t> deflate(const std::uint8_t *data, std::size_t size) {
+    int len;
+    auto stream = stbi_zlib_compress(const_cast<std::uint8_t*>(data), size, &len, 8);
+    if (!stream)
+        return {};
+
+    // Strip the 2 byte zlib header and the trailing adler32 checksum
+    std::vector<std::uint8_t> result(stream + 2, stream + len - 4);
+    STBIW_FREE(stream);
+
+    return result;
+}
+
+bool inflate(const std::uint8_t *src, std::size_t src_size, std::uint8_t *dst, std::size_t dst_size) {
+    int result = stbi_zlib_decode_noheader_buffer(
+        reinterpret_cast<char*>(dst), dst_size,
+        reinterpret_cast<const char*>(src), src_size
+    );
+
+    return result >= 0 && static_cast<std::size_t>(result) == dst_size;
+}
+
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> table;
+        for (std::uint32_t i = 0; i < 256; i++) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    std::uint32_t crc = 0xFFFFFFFF;
+    for (std::size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return crc ^ 0xFFFFFFFF;
+}
+
 }
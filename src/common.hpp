@@ -16,8 +16,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <memory>
 #include <tuple>
+#include <cstdint>
 #include <endian.h>
 
 class Color;
@@ -43,6 +45,14 @@ inline std::uint32_t little32(std::uint32_t n) {
 #endif
 }
 
+inline std::uint64_t little64(std::uint64_t n) {
+#if BYTE_ORDER == BIG_ENDIAN
+    return static_cast<std::uint64_t>(little32(n & 0xFFFFFFFF)) << 32 | little32(n >> 32);
+#else
+    return n;
+#endif
+}
+
 inline bool ends_with(const std::string &str, const std::string &ending) {
     if (ending.size() > str.size())
         return false;
@@ -53,4 +63,10 @@ inline bool ends_with(const std::string &str, const std::string &ending) {
 bool save_image(const std::string &path, const Color *image, unsigned int width, unsigned int height);
 std::tuple<std::unique_ptr<Color[]>, int, int> load_image(const std::string &path);
 
+// Raw deflate streams (No zlib header or checksum), as stored in zip archives
+std::vector<std::uint8_t> deflate(const std::uint8_t *data, std::size_t size);
+bool inflate(const std::uint8_t *src, std::size_t src_size, std::uint8_t *dst, std::size_t dst_size);
+
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size);
+
 };
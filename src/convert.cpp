@@ -0,0 +1,283 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "convert.hpp"
+#include "common.hpp"
+#include "pk3file.hpp"
+#include "wadfile.hpp"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Namespace {
+    const char *dir;
+    const char *folder;
+};
+
+// An entry of the PK3, read from the WAD once it is its turn
+struct Source {
+    std::string path;
+    std::size_t dir;
+    std::size_t lump;
+    bool map;
+};
+
+// The first match wins when converting back to a WAD
+const Namespace namespaces[] = {
+    {"S",  "sprites"},
+    {"SS", "sprites"},
+    {"F",  "flats"},
+    {"FF", "flats"},
+    {"P",  "patches"},
+    {"PP", "patches"},
+};
+
+std::string to_lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+std::string to_upper(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::toupper(c); });
+    return str;
+}
+
+std::string folder_name(const std::string &dir) {
+    for (const auto &ns : namespaces) {
+        if (dir == ns.dir)
+            return ns.folder;
+    }
+
+    return to_lower(dir);
+}
+
+// Returns an empty string for folders that have no WAD equivalent
+std::string dir_name(const std::string &folder, bool top_level) {
+    for (const auto &ns : namespaces) {
+        if (to_lower(folder) == ns.folder)
+            return ns.dir;
+    }
+
+    return top_level ? "" : to_upper(folder);
+}
+
+// Backslashes are path separators to some zip tools (e.g. "VILE\\1")
+std::string file_name(std::string lump) {
+    std::replace(lump.begin(), lump.end(), '\\', '^');
+    return lump;
+}
+
+// The length of a trailing ".N", or 0 if there isn't one
+std::size_t number_suffix(const std::string &name) {
+    auto dot = name.rfind('.');
+    if (dot == std::string::npos || dot == 0 || dot + 1 == name.size())
+        return 0;
+
+    bool digits = std::all_of(name.begin() + dot + 1, name.end(), [](unsigned char c) { return std::isdigit(c); });
+    return digits ? name.size() - dot : 0;
+}
+
+// Drops the ".lmp" or ".wad" extension, along with the ".0", ".1"... given by unique_path
+// (Anything else is kept, lump names can contain dots)
+std::string lump_name(std::string file) {
+    if (file.size() > 4) {
+        auto extension = to_lower(file.substr(file.size() - 4));
+        if (extension == ".lmp" || extension == ".wad")
+            file.resize(file.size() - 4);
+    }
+
+    file.resize(file.size() - number_suffix(file));
+
+    std::replace(file.begin(), file.end(), '^', '\\');
+    file = to_upper(file);
+
+    if (file.size() > 8)
+        file.resize(8);
+
+    return file;
+}
+
+// WADs can repeat a name in the same namespace, but a PK3 can't repeat a path
+// (Names that already end in ".N" always get a suffix, so lump_name only ever strips one)
+std::string unique_path(const std::string &base, const std::string &extension, std::set<std::string> &paths) {
+    auto path = number_suffix(base) ? base + ".0" + extension : base + extension;
+
+    for (int i = 1; paths.count(path); i++)
+        path = base + "." + std::to_string(i) + extension;
+
+    paths.insert(path);
+    return path;
+}
+
+// Packs a single map into a standalone PWAD
+Lump map_wad(WadFile &wad, std::size_t dir_index) {
+    const auto &dir = wad.get_dir(dir_index);
+
+    WadFile map(WadFile::CreatePWAD);
+    auto map_dir = map.create_dir(0, dir.name);
+
+    for (auto i : dir.lumps)
+        map.write_lump(map_dir, wad.lump_name(i), std::move(*wad.read_lump(dir_index, i)));
+
+    return map.save();
+}
+
+void collect_dir(const WadFile &wad, std::size_t dir_index, const std::string &folder,
+    std::vector<Source> &sources, std::set<std::string> &paths)
+{
+    const auto &dir = wad.get_dir(dir_index);
+
+    for (auto i : dir.lumps)
+        sources.push_back({unique_path(folder + file_name(wad.lump_name(i)), ".lmp", paths), dir_index, i, false});
+
+    for (auto i : dir.dirs) {
+        const auto &name = wad.get_dir(i).name;
+
+        if (wad.is_map(i))
+            sources.push_back({unique_path("maps/" + name, ".wad", paths), i, 0, true});
+        else
+            collect_dir(wad, i, folder + folder_name(name) + "/", sources, paths);
+    }
+}
+
+// Splices the maps from an embedded PWAD into the output
+void copy_maps(WadFile &wad, const Lump &lump, const std::string &entry_path) {
+    WadFile map(lump, "Entry " + entry_path);
+    const auto &root = map.root_dir();
+
+    // Anything that wasn't recognized as a map is kept in order
+    for (auto i : root.lumps)
+        wad.write_lump(0, map.lump_name(i), std::move(*map.read_lump(0, i)));
+
+    for (auto d : root.dirs) {
+        auto dir = wad.create_dir(0, map.get_dir(d).name);
+
+        for (auto i : map.get_dir(d).lumps)
+            wad.write_lump(dir, map.lump_name(i), std::move(*map.read_lump(d, i)));
+    }
+}
+
+void write_pk3(const std::string &wad_path, const std::string &pk3_path, bool &created) {
+    WadFile wad(wad_path, WadFile::Open);
+
+    // Only the paths are worked out up front, the lumps are read as the compression catches up
+    std::vector<Source> sources;
+    std::set<std::string> paths;
+    collect_dir(wad, 0, "", sources, paths);
+
+    Pk3File pk3(pk3_path, Pk3File::Create);
+    created = true;
+
+    std::size_t next = 0;
+    auto produce = [&](std::string &path, Lump &lump) {
+        if (next == sources.size())
+            return false;
+
+        const auto &source = sources[next++];
+        path = source.path;
+        lump = source.map ? map_wad(wad, source.dir) : std::move(*wad.read_lump(source.dir, source.lump));
+
+        return true;
+    };
+
+    if (!pk3.write_entries(produce))
+        throw std::runtime_error("Unable to write " + pk3_path);
+}
+
+void write_wad(const std::string &pk3_path, const std::string &wad_path, bool &created) {
+    Pk3File pk3(pk3_path, Pk3File::Open);
+    WadFile wad(wad_path, WadFile::CreatePWAD);
+    created = true;
+
+    std::map<std::string, std::size_t> dirs;
+
+    for (std::size_t i = 0; i < pk3.entry_count(); i++) {
+        const auto &path = pk3.entry_path(i);
+        auto lump = pk3.read_entry(i);
+
+        auto slash = path.rfind('/');
+        auto file = (slash == std::string::npos) ? path : path.substr(slash+1);
+        auto folder = (slash == std::string::npos) ? std::string() : path.substr(0, slash);
+
+        if (to_lower(folder) == "maps" && Common::ends_with(to_lower(file), ".wad")) {
+            copy_maps(wad, *lump, path);
+            continue;
+        }
+
+        // Walk down the folders, creating the directories as needed
+        std::size_t dir = 0;
+        std::string prefix;
+
+        for (std::size_t start = 0; start < folder.size();) {
+            auto end = std::min(folder.find('/', start), folder.size());
+            auto name = dir_name(folder.substr(start, end - start), dir == 0);
+            if (name.empty())
+                break;
+
+            prefix += name + "/";
+            auto it = dirs.find(prefix);
+
+            if (it == dirs.end()) {
+                auto index = wad.create_dir(dir, name);
+                if (!index)
+                    break;
+
+                it = dirs.emplace(prefix, index).first;
+            }
+
+            dir = it->second;
+            start = end + 1;
+        }
+
+        wad.write_lump(dir, lump_name(file), std::move(*lump));
+    }
+}
+
+// Runs a conversion, deleting the partial output if it fails (Once the writer has been closed)
+template<typename Func>
+void convert(const std::string &out_path, Func func) {
+    bool created = false;
+
+    try {
+        func(created);
+    }
+    catch (...) {
+        std::error_code error;
+        if (created)
+            std::filesystem::remove(out_path, error);
+
+        throw;
+    }
+}
+
+}
+
+namespace Convert {
+
+void wad_to_pk3(const std::string &wad_path, const std::string &pk3_path) {
+    convert(pk3_path, [&](bool &created) { write_pk3(wad_path, pk3_path, created); });
+}
+
+void pk3_to_wad(const std::string &pk3_path, const std::string &wad_path) {
+    convert(wad_path, [&](bool &created) { write_wad(pk3_path, wad_path, created); });
+}
+
+};
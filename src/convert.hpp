@@ -0,0 +1,28 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+
+namespace Convert {
+
+// Namespaces become folders (sprites/, flats/, patches/), and each map becomes its own WAD in maps/
+void wad_to_pk3(const std::string &wad_path, const std::string &pk3_path);
+
+// Folders that are not WAD namespaces are flattened into the root directory
+void pk3_to_wad(const std::string &pk3_path, const std::string &wad_path);
+
+};
@@ -0,0 +1,51 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <memory>
+
+#include "lump.hpp"
+#include "palette.hpp"
+
+class Flat : public Lump
+{
+public:
+    Flat() : Lump() {
+    }
+
+    Flat(std::istream &file, std::size_t size) : Lump(file, size) {
+    }
+
+    Flat(const std::string &path) : Lump(path) {
+    }
+
+    // Flats are 64 wide, but some ports allow taller ones
+    unsigned int width() const {
+        return 64;
+    }
+
+    unsigned int height() const {
+        return size_ / 64;
+    }
+
+    std::unique_ptr<Color[]> to_image(Palette &pal) const {
+        auto image = std::make_unique<Color[]>(width() * height());
+        for (std::size_t i = 0; i < width() * height(); i++)
+            image[i] = pal[data_[i]];
+
+        return image;
+    }
+};
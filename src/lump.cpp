@@ -14,14 +14,17 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "lump.hpp"
+#include "stats.hpp"
 #include <fstream>
 
 Lump::Lump() : size_(0) {
 }
 
-Lump::Lump(std::fstream &file, std::size_t size) : size_(size) {
+Lump::Lump(std::istream &file, std::size_t size) : size_(size) {
     data_ = std::make_unique<std::uint8_t[]>(size_);
     file.read(reinterpret_cast<char*>(data_.get()), size_);
+
+    Stats::add_alloc(size_);
 }
 
 Lump::Lump(const std::string &path) {
@@ -36,8 +39,14 @@ Lump::Lump(const std::string &path) {
     file.seekg(0, std::ios::beg);
     file.read(reinterpret_cast<char*>(data_.get()), size_);
     file.close();
+
+    Stats::add_alloc(size_);
+    Stats::add_read(size_);
+}
+
+Lump::Lump(std::unique_ptr<std::uint8_t[]> data, std::size_t size) : size_(size), data_(std::move(data)) {
 }
 
-void Lump::write(std::fstream &file) {
+void Lump::write(std::ostream &file) {
     file.write(reinterpret_cast<char*>(data_.get()), size_);
 }
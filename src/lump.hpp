@@ -16,20 +16,28 @@
 #pragma once
 
 #include <memory>
-#include <fstream>
+#include <istream>
+#include <ostream>
+#include <string>
 
 class Lump
 {
 public:
     Lump();
-    Lump(std::fstream &file, std::size_t size); // From a WAD
+    Lump(std::istream &file, std::size_t size); // From a WAD
     Lump(const std::string &path); // From a file
+    Lump(std::unique_ptr<std::uint8_t[]> data, std::size_t size); // From memory
+
+    Lump(Lump &&) = default;
+    Lump &operator = (Lump &&) = default;
 
     virtual ~Lump() = default;
 
     std::size_t size() const { return size_; }
+    const std::uint8_t *data() const { return data_.get(); }
 
-    void write(std::fstream &file);
+    // Streams aren't counted in the stats, only the caller knows if they are files
+    void write(std::ostream &file);
 
 protected:
     std::size_t size_;
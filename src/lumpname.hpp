@@ -0,0 +1,95 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "common.hpp"
+
+// Lump names packed into a 64-bit integer, first character in the lowest byte and zero-padded,
+// so that they can be compared and hashed without building strings
+namespace LumpNames {
+
+constexpr std::uint64_t pack(const char *name) {
+    std::uint64_t packed = 0;
+    for (int i = 0; i < 8 && name[i]; i++)
+        packed |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(name[i])) << (i * 8);
+
+    return packed;
+}
+
+// For names straight from a WAD directory, which are only null-terminated when shorter than 8
+inline std::uint64_t pack_entry(const char name[8]) {
+    std::uint64_t packed;
+    std::memcpy(&packed, name, sizeof(packed));
+    packed = Common::little64(packed);
+
+    // Clear everything from the first null byte on (Some WADs leave garbage after it)
+    std::uint64_t zeros = (packed - 0x0101010101010101) & ~packed & 0x8080808080808080;
+    return packed & ((zeros & -zeros) - 1);
+}
+
+constexpr std::uint8_t at(std::uint64_t name, int index) {
+    return (name >> (index * 8)) & 0xFF;
+}
+
+constexpr int length(std::uint64_t name) {
+    int len = 0;
+    while (len < 8 && at(name, len))
+        len++;
+
+    return len;
+}
+
+constexpr bool is_digit(std::uint8_t c) {
+    return static_cast<std::uint8_t>(c - '0') < 10;
+}
+
+// ExMy or MAPxx
+constexpr bool is_map_marker(std::uint64_t name) {
+    bool episode = (at(name, 0) == 'E') & is_digit(at(name, 1)) &
+                   (at(name, 2) == 'M') & is_digit(at(name, 3)) & ((name >> 32) == 0);
+
+    bool map = ((name & 0xFFFFFF) == pack("MAP")) &
+               is_digit(at(name, 3)) & is_digit(at(name, 4)) & ((name >> 40) == 0);
+
+    return episode | map;
+}
+
+// Returns the namespace of a "XX_START" marker, or 0 if it isn't one
+constexpr std::uint64_t start_marker(std::uint64_t name) {
+    int len = length(name);
+    if (len < 7)
+        return 0;
+
+    int prefix = (len - 6) * 8;
+    if ((name >> prefix) != pack("_START"))
+        return 0;
+
+    return name & ((std::uint64_t(1) << prefix) - 1);
+}
+
+constexpr std::uint64_t end_marker(std::uint64_t prefix) {
+    return prefix | pack("_END") << (length(prefix) * 8);
+}
+
+static_assert(is_map_marker(pack("MAP01")) && is_map_marker(pack("E1M1")));
+static_assert(!is_map_marker(pack("MAPX1")) && !is_map_marker(pack("MAP011")) && !is_map_marker(pack("E1M10")));
+static_assert(start_marker(pack("FF_START")) == pack("FF") && end_marker(pack("FF")) == pack("FF_END"));
+static_assert(start_marker(pack("_START")) == 0 && start_marker(pack("FF_END")) == 0);
+
+};
@@ -9,7 +9,7 @@ public:
     Palette() : Lump() {
     }
 
-    Palette(std::fstream &file, std::size_t size) : Lump(file, size) {
+    Palette(std::istream &file, std::size_t size) : Lump(file, size) {
     }
 
     Palette(const std::string &path) : Lump(path) {
@@ -0,0 +1,163 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "picture.hpp"
+#include "common.hpp"
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+
+std::uint16_t read16(const std::uint8_t *p) {
+    std::uint16_t n;
+    std::memcpy(&n, p, sizeof(n));
+    return Common::little16(n);
+}
+
+std::uint32_t read32(const std::uint8_t *p) {
+    std::uint32_t n;
+    std::memcpy(&n, p, sizeof(n));
+    return Common::little32(n);
+}
+
+}
+
+bool Picture::valid() const {
+    decode();
+    return valid_;
+}
+
+int Picture::width() const {
+    decode();
+    return width_;
+}
+
+int Picture::height() const {
+    decode();
+    return height_;
+}
+
+int Picture::left() const {
+    decode();
+    return left_;
+}
+
+int Picture::top() const {
+    decode();
+    return top_;
+}
+
+int Picture::pixel(int x, int y) const {
+    decode();
+    assert(x >= 0 && x < width_ && y >= 0 && y < height_);
+
+    // Later posts are drawn over earlier ones
+    for (auto i = columns_[x].last; i-- > columns_[x].first;) {
+        const auto &post = posts_[i];
+        if (y >= post.top && y < post.top + post.length)
+            return data_[post.offset + (y - post.top)];
+    }
+
+    return -1;
+}
+
+std::unique_ptr<Color[]> Picture::to_image(Palette &pal) const {
+    decode();
+
+    // Transparent pixels are left at 0 alpha
+    auto image = std::make_unique<Color[]>(static_cast<std::size_t>(width_) * height_);
+    for (int x = 0; x < width_; x++) {
+        for (auto i = columns_[x].first; i < columns_[x].last; i++) {
+            const auto &post = posts_[i];
+            for (int y = 0; y < post.length; y++)
+                image[(post.top + y)*width_ + x] = pal[data_[post.offset + y]];
+        }
+    }
+
+    return image;
+}
+
+void Picture::decode() const {
+    if (decoded_)
+        return;
+
+    decoded_ = true;
+
+    if (size_ < 8)
+        return;
+
+    const auto *data = data_.get();
+    int width  = static_cast<std::int16_t>(read16(data+0));
+    int height = static_cast<std::int16_t>(read16(data+2));
+
+    if (width <= 0 || height <= 0 || 8 + static_cast<std::size_t>(width)*4 > size_)
+        return;
+
+    // Both only grow with the data, every column takes 4 bytes and every post at least 4 more
+    std::vector<Column> columns(width);
+    std::vector<Post> posts;
+    std::unordered_map<std::size_t, Column> shared;
+
+    for (int x = 0; x < width; x++) {
+        std::size_t offset = read32(data + 8 + x*4);
+        int last_top = -1;
+
+        auto it = shared.find(offset);
+        if (it != shared.end()) {
+            columns[x] = it->second;
+            continue;
+        }
+
+        auto start = offset;
+        columns[x].first = posts.size();
+
+        // Each column is a list of posts, ended by 0xFF
+        while (offset < size_ && data[offset] != 0xFF) {
+            if (offset + 4 > size_)
+                return;
+
+            // Tall patches use relative offsets once they go past 254
+            int top = data[offset];
+            top = (top <= last_top) ? last_top + top : top;
+            last_top = top;
+
+            std::size_t length = data[offset+1];
+            if (offset + 4 + length > size_)
+                return;
+
+            // Skip the padding bytes before and after the pixels
+            if (top < height)
+                posts.push_back({top, std::min(static_cast<int>(length), height - top), offset + 3});
+
+            offset += length + 4;
+        }
+
+        // Columns that start part way into another one can still repeat posts, which only junk does this much
+        if (offset >= size_ || posts.size() > size_)
+            return;
+
+        columns[x].last = posts.size();
+        shared.emplace(start, columns[x]);
+    }
+
+    width_   = width;
+    height_  = height;
+    left_    = static_cast<std::int16_t>(read16(data+4));
+    top_     = static_cast<std::int16_t>(read16(data+6));
+    columns_ = std::move(columns);
+    posts_   = std::move(posts);
+    valid_   = true;
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "lump.hpp"
+#include "palette.hpp"
+
+// A column-based DOOM patch, used for sprites, wall patches and most graphics
+class Picture : public Lump
+{
+public:
+    Picture() : Lump() {
+    }
+
+    Picture(std::istream &file, std::size_t size) : Lump(file, size) {
+    }
+
+    Picture(const std::string &path) : Lump(path) {
+    }
+
+    bool valid() const;
+
+    int width() const;
+    int height() const;
+    int left() const;
+    int top() const;
+
+    // Palette index of a pixel, or -1 if it is transparent
+    int pixel(int x, int y) const;
+
+    std::unique_ptr<Color[]> to_image(Palette &pal) const;
+
+private:
+    struct Post {
+        int top;
+        int length;         // Clipped to the height
+        std::size_t offset; // Of the first pixel in the data
+    };
+
+    // A range of posts, columns with the same offset share theirs
+    struct Column {
+        std::size_t first;
+        std::size_t last;
+    };
+
+    void decode() const;
+
+    // Filled in on first access, only the posts are kept so junk can't claim more memory than the lump holds
+    mutable bool decoded_ = false;
+    mutable bool valid_ = false;
+    mutable int width_ = 0, height_ = 0, left_ = 0, top_ = 0;
+    mutable std::vector<Column> columns_;
+    mutable std::vector<Post> posts_;
+};
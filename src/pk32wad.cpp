@@ -0,0 +1,60 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include "convert.hpp"
+#include "stats.hpp"
+
+int main(int argc, char **argv) {
+    Stats::Format stats = Stats::None;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (!Stats::parse_arg(arg, stats))
+            paths.push_back(arg);
+    }
+
+    if (paths.empty()) {
+        std::cout << "Usage: " << argv[0] << " [--stats | --stats-json] [PK3 PATHS...]" << std::endl;
+        Stats::usage(std::cout);
+        return 1;
+    }
+
+    for (const auto &path : paths) {
+        auto wad_path = std::filesystem::path(path).stem().string() + ".wad";
+        std::cout << "Converting " << path << " to " << wad_path << "..." << std::endl;
+
+        try {
+            // Never replace an existing file (e.g. the WAD a PK3 was made from)
+            if (std::filesystem::exists(wad_path))
+                throw std::runtime_error(wad_path + " already exists");
+
+            Convert::pk3_to_wad(path, wad_path);
+        }
+        catch (const std::exception &ex) {
+            std::cerr << "Error: " << ex.what() << std::endl;
+            Stats::print(std::cerr, stats);
+            return 1;
+        }
+    }
+
+    Stats::print(std::cerr, stats);
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "pk3file.hpp"
+#include "common.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+const std::uint32_t LocalSignature   = 0x04034B50;
+const std::uint32_t CentralSignature = 0x02014B50;
+const std::uint32_t EndSignature     = 0x06054B50;
+
+const std::size_t LocalHeaderSize   = 30;
+const std::size_t CentralHeaderSize = 46;
+const std::size_t EndRecordSize     = 22;
+
+const std::uint16_t Version = 20;   // 2.0, the first version with deflate
+const std::uint16_t DosTime = 0;    // 00:00:00
+const std::uint16_t DosDate = 0x21; // 1980-01-01, keeps the output reproducible
+
+// Zip fields are little-endian and unaligned, so they are packed by hand
+void put16(std::vector<std::uint8_t> &buf, std::uint16_t n) {
+    buf.push_back(n & 0xFF);
+    buf.push_back(n >> 8);
+}
+
+void put32(std::vector<std::uint8_t> &buf, std::uint32_t n) {
+    put16(buf, n & 0xFFFF);
+    put16(buf, n >> 16);
+}
+
+std::uint16_t get16(const std::uint8_t *p) {
+    return p[0] | p[1] << 8;
+}
+
+std::uint32_t get32(const std::uint8_t *p) {
+    return get16(p) | static_cast<std::uint32_t>(get16(p+2)) << 16;
+}
+
+}
+
+Pk3File::Pk3File(const std::string &path, Mode mode) : mode_(mode) {
+    if (mode == Mode::Open)
+        open(path);
+    else
+        create(path);
+}
+
+Pk3File::~Pk3File() {
+    // Only for saving
+    if (mode_ == Mode::Open)
+        return;
+
+    Stats::Timer timer(Stats::Pk3Write);
+
+    std::uint32_t offset = file.tellp();
+
+    // Stream out the central directory
+    std::vector<std::uint8_t> buf;
+    for (const auto &entry : entries) {
+        buf.clear();
+        put32(buf, CentralSignature);
+        put16(buf, Version); // Made by
+        put16(buf, Version); // Needed to extract
+        put16(buf, 0);       // Flags
+        put16(buf, entry.method);
+        put16(buf, DosTime);
+        put16(buf, DosDate);
+        put32(buf, entry.crc);
+        put32(buf, entry.compressed_size);
+        put32(buf, entry.size);
+        put16(buf, entry.path.size());
+        put16(buf, 0);       // Extra field length
+        put16(buf, 0);       // Comment length
+        put16(buf, 0);       // Disk number
+        put16(buf, 0);       // Internal attributes
+        put32(buf, 0);       // External attributes
+        put32(buf, entry.offset);
+
+        file.write(reinterpret_cast<char*>(buf.data()), buf.size());
+        file.write(entry.path.data(), entry.path.size());
+    }
+
+    std::uint32_t size = static_cast<std::uint32_t>(file.tellp()) - offset;
+
+    // End of central directory record
+    buf.clear();
+    put32(buf, EndSignature);
+    put16(buf, 0); // Disk number
+    put16(buf, 0); // Disk with the central directory
+    put16(buf, entries.size());
+    put16(buf, entries.size());
+    put32(buf, size);
+    put32(buf, offset);
+    put16(buf, 0); // Comment length
+
+    file.write(reinterpret_cast<char*>(buf.data()), buf.size());
+    file.close();
+
+    Stats::add_written(size + buf.size());
+}
+
+std::size_t Pk3File::entry_count() const {
+    return entries.size();
+}
+
+const std::string &Pk3File::entry_path(std::size_t index) const {
+    assert(index < entries.size());
+
+    return entries[index].path;
+}
+
+std::size_t Pk3File::entry_size(std::size_t index) const {
+    assert(index < entries.size());
+
+    return entries[index].size;
+}
+
+std::unique_ptr<Lump> Pk3File::read_entry(std::size_t index) {
+    assert(index < entries.size());
+
+    Stats::Timer timer(Stats::Pk3Read);
+
+    if (mode_ != Mode::Open)
+        return std::make_unique<Lump>();
+
+    const auto &entry = entries[index];
+
+    // Skip over the local header, its name and extra field can differ from the central one
+    std::uint8_t header[LocalHeaderSize];
+    file.seekg(entry.offset, std::ios::beg);
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+    if (!file.good() || get32(header) != LocalSignature)
+        throw std::runtime_error("Bad local header for " + entry.path);
+
+    file.seekg(get16(header+26) + get16(header+28), std::ios::cur);
+
+    auto packed = std::make_unique<std::uint8_t[]>(entry.compressed_size);
+    file.read(reinterpret_cast<char*>(packed.get()), entry.compressed_size);
+
+    if (!file.good())
+        throw std::runtime_error("Truncated entry " + entry.path);
+
+    Stats::add_read(sizeof(header) + get16(header+26) + get16(header+28) + entry.compressed_size);
+    Stats::add_alloc(entry.compressed_size);
+
+    std::unique_ptr<std::uint8_t[]> data;
+    if (entry.method == Method::Store && entry.compressed_size == entry.size) {
+        data = std::move(packed);
+    }
+
+    else if (entry.method == Method::Deflate) {
+        data = std::make_unique<std::uint8_t[]>(entry.size);
+        Stats::add_alloc(entry.size);
+
+        if (!Common::inflate(packed.get(), entry.compressed_size, data.get(), entry.size))
+            throw std::runtime_error("Unable to inflate " + entry.path);
+    }
+
+    else {
+        throw std::runtime_error("Unsupported compression method for " + entry.path);
+    }
+
+    if (Common::crc32(data.get(), entry.size) != entry.crc)
+        throw std::runtime_error("CRC mismatch in " + entry.path);
+
+    return std::make_unique<Lump>(std::move(data), entry.size);
+}
+
+bool Pk3File::write_entry(const std::string &path, const Lump &lump) {
+    if (mode_ == Mode::Open || path.empty() || path.size() > 0xFFFF || paths.count(path))
+        return false;
+
+    paths.insert(path);
+    write_compressed(compress(path, lump));
+
+    return true;
+}
+
+bool Pk3File::write_entries(const Producer &produce) {
+    if (mode_ == Mode::Open)
+        return false;
+
+    // Enough to keep every core busy, without holding the whole input in memory
+    const std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t max_entries  = thread_count * 4;
+    const std::size_t max_bytes    = 64 * 1024 * 1024;
+
+    struct Job {
+        std::size_t index;
+        std::string path;
+        Lump lump;
+    };
+
+    std::deque<Job> jobs;
+    std::map<std::size_t, Compressed> results;
+    std::exception_ptr error;
+    bool done = false;
+
+    std::mutex mutex;
+    std::condition_variable job_cond, result_cond;
+
+    // Each worker takes the next lump, compresses it and hands it back for writing
+    auto worker = [&] {
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_cond.wait(lock, [&] { return !jobs.empty() || done; });
+
+                if (jobs.empty())
+                    return;
+
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Compressed result;
+            std::exception_ptr failure;
+
+            try {
+                result = compress(job.path, job.lump);
+            }
+            catch (...) {
+                failure = std::current_exception();
+            }
+
+            job.lump = Lump();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (failure && !error)
+                    error = failure;
+
+                results.emplace(job.index, std::move(result));
+            }
+
+            result_cond.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; i++)
+        threads.emplace_back(worker);
+
+    bool valid = true;
+
+    // Write the entries in order as soon as they are done, so the output stays deterministic
+    try {
+        std::size_t produced = 0, written = 0, in_flight = 0;
+        bool more = true;
+
+        for (;;) {
+            // Read ahead while there is room (And always at least one entry)
+            while (more && (produced == written || (produced - written < max_entries && in_flight < max_bytes))) {
+                Job job;
+                job.index = produced;
+
+                if (!produce(job.path, job.lump)) {
+                    more = false;
+                    break;
+                }
+
+                if (job.path.empty() || job.path.size() > 0xFFFF || !paths.insert(job.path).second) {
+                    valid = more = false;
+                    break;
+                }
+
+                in_flight += job.lump.size();
+                produced++;
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    jobs.push_back(std::move(job));
+                }
+
+                job_cond.notify_one();
+            }
+
+            if (written == produced)
+                break;
+
+            Compressed result;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                result_cond.wait(lock, [&] { return results.count(written) != 0; });
+
+                if (error)
+                    break;
+
+                auto it = results.find(written);
+                result = std::move(it->second);
+                results.erase(it);
+            }
+
+            in_flight -= result.entry.size;
+            write_compressed(std::move(result));
+            written++;
+        }
+    }
+    catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error)
+            error = std::current_exception();
+    }
+
+    // Drop anything still queued, and wait for the workers to finish
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.clear();
+        done = true;
+    }
+
+    job_cond.notify_all();
+    for (auto &thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return valid;
+}
+
+void Pk3File::open(const std::string &path) {
+    file = std::fstream(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.good())
+        throw std::runtime_error("Unable to open file " + path);
+
+    // The end record sits at the very end, followed by an optional comment of up to 64K
+    std::size_t size = file.tellg();
+    std::size_t tail_size = std::min<std::size_t>(size, EndRecordSize + 0xFFFF);
+
+    std::vector<std::uint8_t> tail(tail_size);
+    file.seekg(size - tail_size, std::ios::beg);
+    file.read(reinterpret_cast<char*>(tail.data()), tail_size);
+    Stats::add_read(tail_size);
+
+    if (tail_size < EndRecordSize)
+        throw std::runtime_error("File " + path + " is not a PK3");
+
+    // Search backwards for the end record
+    std::size_t end;
+    for (end = tail_size - EndRecordSize + 1; end-- > 0;) {
+        if (get32(&tail[end]) == EndSignature)
+            break;
+    }
+
+    if (end == static_cast<std::size_t>(-1))
+        throw std::runtime_error("File " + path + " is not a PK3");
+
+    std::size_t count  = get16(&tail[end+10]);
+    std::size_t offset = get32(&tail[end+16]);
+
+    // Stream in the central directory
+    file.seekg(offset, std::ios::beg);
+    entries.reserve(count);
+
+    for (std::size_t i = 0; i < count; i++) {
+        std::uint8_t header[CentralHeaderSize];
+        file.read(reinterpret_cast<char*>(header), sizeof(header));
+
+        if (!file.good() || get32(header) != CentralSignature)
+            throw std::runtime_error("Bad central directory in " + path);
+
+        Entry entry;
+        entry.method          = get16(header+10);
+        entry.crc             = get32(header+16);
+        entry.compressed_size = get32(header+20);
+        entry.size            = get32(header+24);
+        entry.offset          = get32(header+42);
+
+        entry.path.resize(get16(header+28));
+        file.read(&entry.path[0], entry.path.size());
+
+        // Skip the extra field and comment
+        file.seekg(get16(header+30) + get16(header+32), std::ios::cur);
+        Stats::add_read(sizeof(header) + entry.path.size());
+
+        // Encrypted entries can't be read
+        if (get16(header+8) & 1)
+            throw std::runtime_error("Entry " + entry.path + " is encrypted");
+
+        // Directories are implied by the paths
+        if (!entry.path.empty() && entry.path.back() != '/')
+            entries.push_back(std::move(entry));
+    }
+}
+
+void Pk3File::create(const std::string &path) {
+    file = std::fstream(path, std::ios::out | std::ios::binary);
+    if (!file.good())
+        throw std::runtime_error("Unable to create file " + path);
+}
+
+Pk3File::Compressed Pk3File::compress(const std::string &path, const Lump &lump) {
+    Stats::Timer timer(Stats::Deflate);
+
+    Compressed result;
+    result.entry.path   = path;
+    result.entry.size   = lump.size();
+    result.entry.crc    = Common::crc32(lump.data(), lump.size());
+    result.entry.offset = 0;
+
+    if (lump.size())
+        result.data = Common::deflate(lump.data(), lump.size());
+
+    // Store the lump if it doesn't compress
+    if (result.data.empty() || result.data.size() >= lump.size()) {
+        result.entry.method = Method::Store;
+        result.data.assign(lump.data(), lump.data() + lump.size());
+    }
+    else {
+        result.entry.method = Method::Deflate;
+    }
+
+    result.entry.compressed_size = result.data.size();
+
+    return result;
+}
+
+void Pk3File::write_compressed(Compressed compressed) {
+    Stats::Timer timer(Stats::Pk3Write);
+
+    // Without zip64 extensions the archive is limited to 64K entries and 4GB
+    std::size_t offset = file.tellp();
+    if (entries.size() >= 0xFFFF || offset + compressed.data.size() > 0xFFFFFFFF)
+        throw std::runtime_error("PK3 file is too large");
+
+    auto &entry = compressed.entry;
+    entry.offset = offset;
+
+    std::vector<std::uint8_t> header;
+    put32(header, LocalSignature);
+    put16(header, Version);
+    put16(header, 0); // Flags
+    put16(header, entry.method);
+    put16(header, DosTime);
+    put16(header, DosDate);
+    put32(header, entry.crc);
+    put32(header, entry.compressed_size);
+    put32(header, entry.size);
+    put16(header, entry.path.size());
+    put16(header, 0); // Extra field length
+
+    file.write(reinterpret_cast<char*>(header.data()), header.size());
+    file.write(entry.path.data(), entry.path.size());
+    file.write(reinterpret_cast<char*>(compressed.data.data()), compressed.data.size());
+
+    Stats::add_written(header.size() + entry.path.size() + compressed.data.size());
+
+    entries.push_back(std::move(entry));
+}
@@ -0,0 +1,84 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <memory>
+#include <fstream>
+#include <functional>
+
+#include "lump.hpp"
+
+class Pk3File
+{
+public:
+    enum Mode {
+        Open,
+        Create
+    };
+
+    // Fills in the next entry to write, returning false once there are none left
+    using Producer = std::function<bool(std::string &path, Lump &lump)>;
+
+    Pk3File(const std::string &path, Mode mode);
+    ~Pk3File();
+
+    std::size_t entry_count() const;
+    const std::string &entry_path(std::size_t index) const;
+    std::size_t entry_size(std::size_t index) const;
+
+    std::unique_ptr<Lump> read_entry(std::size_t index);
+    bool write_entry(const std::string &path, const Lump &lump);
+
+    // Compresses the entries across all cores, writing them in the order they were produced
+    // The producer runs on the calling thread while earlier entries compress, and stops while too many bytes are in flight
+    // Fails if a path is empty, too long or already used (The entries before it are still written)
+    bool write_entries(const Producer &produce);
+
+private:
+    enum Method : std::uint16_t {
+        Store   = 0,
+        Deflate = 8
+    };
+
+    struct Entry {
+        std::string path;
+        std::uint16_t method;
+        std::uint32_t crc;
+        std::uint32_t compressed_size;
+        std::uint32_t size;
+        std::uint32_t offset;
+    };
+
+    struct Compressed {
+        Entry entry;
+        std::vector<std::uint8_t> data;
+    };
+
+    void open(const std::string &path);
+    void create(const std::string &path);
+
+    static Compressed compress(const std::string &path, const Lump &lump);
+    void write_compressed(Compressed compressed);
+
+    Mode mode_;
+
+    std::vector<Entry> entries;
+    std::unordered_set<std::string> paths;
+    std::fstream file;
+};
@@ -0,0 +1,73 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "registry.hpp"
+#include "palette.hpp"
+#include "colormap.hpp"
+#include "picture.hpp"
+#include "flat.hpp"
+#include "sound.hpp"
+#include "maplump.hpp"
+
+namespace {
+
+using Reader = std::unique_ptr<Lump> (*)(std::istream &file, std::size_t size);
+
+template<typename T>
+std::unique_ptr<Lump> read_as(std::istream &file, std::size_t size) {
+    return std::make_unique<T>(file, size);
+}
+
+template<LumpType Type>
+std::unique_ptr<Lump> read_map(std::istream &file, std::size_t size) {
+    return std::make_unique<MapLump>(file, size, Type);
+}
+
+// Indexed by LumpType
+const Reader readers[] = {
+    read_as<Lump>,
+    read_as<Palette>,
+    read_as<ColorMap>,
+    read_as<Picture>,
+    read_as<Flat>,
+    read_as<Sound>,
+    read_map<LumpType::Things>,
+    read_map<LumpType::Linedefs>,
+    read_map<LumpType::Sidedefs>,
+    read_map<LumpType::Vertexes>,
+    read_map<LumpType::Segs>,
+    read_map<LumpType::SSectors>,
+    read_map<LumpType::Nodes>,
+    read_map<LumpType::Sectors>,
+    read_map<LumpType::Reject>,
+    read_map<LumpType::Blockmap>,
+    read_map<LumpType::Behavior>,
+    read_map<LumpType::Scripts>,
+    read_map<LumpType::TextMap>,
+    read_map<LumpType::EndMap>,
+};
+
+static_assert(sizeof(readers) / sizeof(readers[0]) == static_cast<std::size_t>(LumpType::Count),
+    "Every lump type needs a reader");
+
+}
+
+namespace Registry {
+
+std::unique_ptr<Lump> read(LumpType type, std::istream &file, std::size_t size) {
+    return readers[static_cast<std::size_t>(type)](file, size);
+}
+
+};
@@ -0,0 +1,184 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <istream>
+
+#include "lump.hpp"
+#include "lumpname.hpp"
+
+enum class LumpType : std::uint8_t {
+    Raw,
+    Palette,
+    ColorMap,
+    Picture,
+    Flat,
+    Sound,
+
+    // Map lumps
+    Things,
+    Linedefs,
+    Sidedefs,
+    Vertexes,
+    Segs,
+    SSectors,
+    Nodes,
+    Sectors,
+    Reject,
+    Blockmap,
+    Behavior,   // Hexen
+    Scripts,
+    TextMap,    // UDMF
+    EndMap,
+
+    Count
+};
+
+namespace Registry {
+
+struct Entry {
+    std::uint64_t name = 0;
+    LumpType type = LumpType::Raw;
+};
+
+// Lumps that are known by name, add new ones here
+constexpr Entry names[] = {
+    {LumpNames::pack("PLAYPAL"),  LumpType::Palette},
+    {LumpNames::pack("COLORMAP"), LumpType::ColorMap},
+
+    {LumpNames::pack("TITLEPIC"), LumpType::Picture},
+    {LumpNames::pack("CREDIT"),   LumpType::Picture},
+    {LumpNames::pack("HELP"),     LumpType::Picture},
+    {LumpNames::pack("HELP1"),    LumpType::Picture},
+    {LumpNames::pack("HELP2"),    LumpType::Picture},
+    {LumpNames::pack("INTERPIC"), LumpType::Picture},
+    {LumpNames::pack("VICTORY2"), LumpType::Picture},
+    {LumpNames::pack("ENDPIC"),   LumpType::Picture},
+    {LumpNames::pack("BOSSBACK"), LumpType::Picture},
+    {LumpNames::pack("PFUB1"),    LumpType::Picture},
+    {LumpNames::pack("PFUB2"),    LumpType::Picture},
+    {LumpNames::pack("STBAR"),    LumpType::Picture},
+
+    {LumpNames::pack("THINGS"),   LumpType::Things},
+    {LumpNames::pack("LINEDEFS"), LumpType::Linedefs},
+    {LumpNames::pack("SIDEDEFS"), LumpType::Sidedefs},
+    {LumpNames::pack("VERTEXES"), LumpType::Vertexes},
+    {LumpNames::pack("SEGS"),     LumpType::Segs},
+    {LumpNames::pack("SSECTORS"), LumpType::SSectors},
+    {LumpNames::pack("NODES"),    LumpType::Nodes},
+    {LumpNames::pack("SECTORS"),  LumpType::Sectors},
+    {LumpNames::pack("REJECT"),   LumpType::Reject},
+    {LumpNames::pack("BLOCKMAP"), LumpType::Blockmap},
+    {LumpNames::pack("BEHAVIOR"), LumpType::Behavior},
+    {LumpNames::pack("SCRIPTS"),  LumpType::Scripts},
+    {LumpNames::pack("TEXTMAP"),  LumpType::TextMap},
+    {LumpNames::pack("ENDMAP"),   LumpType::EndMap},
+};
+
+// Namespaces that decide the type of the lumps inside of them (And their sub-namespaces)
+constexpr Entry namespaces[] = {
+    {LumpNames::pack("S"),  LumpType::Picture},
+    {LumpNames::pack("SS"), LumpType::Picture},
+    {LumpNames::pack("P"),  LumpType::Picture},
+    {LumpNames::pack("PP"), LumpType::Picture},
+    {LumpNames::pack("F"),  LumpType::Flat},
+    {LumpNames::pack("FF"), LumpType::Flat},
+};
+
+// A perfect hash of the known names, so that a lookup is a multiply, a shift and a single compare
+struct Table {
+    static constexpr int bits = 7;
+
+    std::uint64_t multiplier = 0;
+    std::array<Entry, 1 << bits> slots;
+
+    constexpr std::size_t slot(std::uint64_t name) const {
+        return (name * multiplier) >> (64 - bits);
+    }
+
+    constexpr LumpType find(std::uint64_t name) const {
+        const auto &entry = slots[slot(name)];
+        return entry.name == name ? entry.type : LumpType::Raw;
+    }
+};
+
+// Tries multipliers from a splitmix64 sequence until none of the names collide
+constexpr Table build_table() {
+    std::uint64_t seed = 0;
+
+    for (int attempt = 0; attempt < 10000; attempt++) {
+        seed += 0x9E3779B97F4A7C15;
+        std::uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        z ^= z >> 31;
+
+        Table table;
+        table.multiplier = z | 1;
+
+        bool collision = false;
+        for (const auto &entry : names) {
+            auto &slot = table.slots[table.slot(entry.name)];
+            if (slot.name) {
+                collision = true;
+                break;
+            }
+
+            slot = entry;
+        }
+
+        if (!collision)
+            return table;
+    }
+
+    return Table();
+}
+
+constexpr Table table = build_table();
+static_assert(table.multiplier != 0, "No perfect hash for the lump names, increase Table::bits");
+
+constexpr LumpType namespace_type(std::uint64_t name) {
+    for (const auto &entry : namespaces) {
+        if (entry.name == name)
+            return entry.type;
+    }
+
+    return LumpType::Raw;
+}
+
+// The lumps of a Doom or Hexen format map (UDMF maps run from TEXTMAP to ENDMAP instead)
+constexpr bool is_map_lump(std::uint64_t name) {
+    auto type = table.find(name);
+    return type >= LumpType::Things && type <= LumpType::Scripts;
+}
+
+constexpr int map_lump_count = static_cast<int>(LumpType::Scripts) - static_cast<int>(LumpType::Things) + 1;
+
+// Known names win over the namespace, and "DS" lumps are sound effects
+constexpr LumpType classify(std::uint64_t name, LumpType ns) {
+    auto type = table.find(name);
+    type = (type == LumpType::Raw) ? ns : type;
+
+    bool sound = (type == LumpType::Raw) & ((name & 0xFFFF) == LumpNames::pack("DS"));
+    return sound ? LumpType::Sound : type;
+}
+
+// Creates the typed lump, which decodes itself on first access
+std::unique_ptr<Lump> read(LumpType type, std::istream &file, std::size_t size);
+
+};
@@ -0,0 +1,69 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "sound.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cstring>
+
+bool Sound::valid() const {
+    decode();
+    return rate_ != 0;
+}
+
+unsigned int Sound::rate() const {
+    decode();
+    return rate_;
+}
+
+std::size_t Sound::sample_count() const {
+    decode();
+    return count_;
+}
+
+const std::uint8_t *Sound::samples() const {
+    decode();
+    return data_.get() + offset_;
+}
+
+void Sound::decode() const {
+    if (decoded_)
+        return;
+
+    decoded_ = true;
+
+    // Format (Always 3), sample rate and sample count
+    if (size_ < 8)
+        return;
+
+    std::uint16_t format, rate;
+    std::uint32_t count;
+    std::memcpy(&format, &data_[0], sizeof(format));
+    std::memcpy(&rate,   &data_[2], sizeof(rate));
+    std::memcpy(&count,  &data_[4], sizeof(count));
+
+    if (Common::little16(format) != 3)
+        return;
+
+    rate_   = Common::little16(rate);
+    count_  = std::min<std::size_t>(Common::little32(count), size_ - 8);
+    offset_ = 8;
+
+    // The count includes 16 padding samples at either end
+    if (count_ >= 32) {
+        count_  -= 32;
+        offset_ += 16;
+    }
+}
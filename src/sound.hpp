@@ -0,0 +1,46 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "lump.hpp"
+
+// A DMX sound effect, 8-bit unsigned mono samples
+class Sound : public Lump
+{
+public:
+    Sound() : Lump() {
+    }
+
+    Sound(std::istream &file, std::size_t size) : Lump(file, size) {
+    }
+
+    Sound(const std::string &path) : Lump(path) {
+    }
+
+    bool valid() const;
+    unsigned int rate() const;
+
+    std::size_t sample_count() const;
+    const std::uint8_t *samples() const;
+
+private:
+    void decode() const;
+
+    // Filled in on first access
+    mutable bool decoded_ = false;
+    mutable unsigned int rate_ = 0;
+    mutable std::size_t offset_ = 0, count_ = 0;
+};
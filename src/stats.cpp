@@ -0,0 +1,199 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "stats.hpp"
+
+#ifdef WADTOOLS_STATS
+
+#include <atomic>
+#include <cstdio>
+
+namespace {
+
+struct Counters {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> ns{0};
+    std::atomic<std::uint64_t> read{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> alloc_bytes{0};
+};
+
+const char *const phase_names[Stats::PhaseCount] = {
+    "other", "open", "create_dirs", "read_lump", "write_lump", "flush",
+    "save_image", "load_image", "pk3_read", "pk3_write", "deflate"
+};
+
+Counters counters[Stats::PhaseCount];
+thread_local Stats::Phase current = Stats::Other;
+
+const auto start = std::chrono::steady_clock::now();
+
+std::uint64_t get(const std::atomic<std::uint64_t> &n) {
+    return n.load(std::memory_order_relaxed);
+}
+
+void add(std::atomic<std::uint64_t> &n, std::uint64_t value) {
+    n.fetch_add(value, std::memory_order_relaxed);
+}
+
+double per_second(std::uint64_t n, std::uint64_t ns) {
+    return ns ? n / (ns / 1e9) : 0.0;
+}
+
+}
+
+namespace Stats {
+
+bool active = false;
+
+void add_read(std::uint64_t bytes) {
+    if (active)
+        add(counters[current].read, bytes);
+}
+
+void add_written(std::uint64_t bytes) {
+    if (active)
+        add(counters[current].written, bytes);
+}
+
+void add_alloc(std::uint64_t bytes) {
+    if (!active)
+        return;
+
+    add(counters[current].allocs, 1);
+    add(counters[current].alloc_bytes, bytes);
+}
+
+Phase enter(Phase phase) {
+    auto previous = current;
+    current = phase;
+    return previous;
+}
+
+void leave(Phase phase, Phase previous, std::uint64_t ns) {
+    add(counters[phase].calls, 1);
+    add(counters[phase].ns, ns);
+    current = previous;
+}
+
+void print(std::ostream &out, Format format) {
+    if (format == Format::None)
+        return;
+
+    std::uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    std::uint64_t read = 0, written = 0;
+    for (const auto &c : counters) {
+        read    += get(c.read);
+        written += get(c.written);
+    }
+
+    const auto &reads  = counters[ReadLump];
+    const auto &writes = counters[WriteLump];
+
+    char line[256];
+
+    if (format == Format::Json) {
+        out << "{\"elapsed_ns\":" << elapsed
+            << ",\"bytes_read\":" << read
+            << ",\"bytes_written\":" << written;
+
+        std::snprintf(line, sizeof(line), ",\"lumps_read_per_s\":%.2f,\"lumps_written_per_s\":%.2f",
+            per_second(get(reads.calls), get(reads.ns)), per_second(get(writes.calls), get(writes.ns)));
+        out << line << ",\"phases\":{";
+
+        for (int i = 0; i < PhaseCount; i++) {
+            const auto &c = counters[i];
+            out << (i ? "," : "") << "\"" << phase_names[i] << "\":{"
+                << "\"calls\":"        << get(c.calls)
+                << ",\"ns\":"          << get(c.ns)
+                << ",\"bytes_read\":"  << get(c.read)
+                << ",\"bytes_written\":" << get(c.written)
+                << ",\"allocs\":"      << get(c.allocs)
+                << ",\"alloc_bytes\":" << get(c.alloc_bytes) << "}";
+        }
+
+        out << "}}" << std::endl;
+        return;
+    }
+
+    // Phase times are inclusive of the phases nested in them (e.g. open includes create_dirs)
+    std::snprintf(line, sizeof(line), "%-12s %10s %12s %12s %12s %10s",
+        "Phase", "Calls", "Time (ms)", "Read (KB)", "Written (KB)", "Allocs");
+    out << line << std::endl;
+
+    for (int i = 0; i < PhaseCount; i++) {
+        const auto &c = counters[i];
+        if (!get(c.calls) && !get(c.read) && !get(c.written) && !get(c.allocs))
+            continue;
+
+        std::snprintf(line, sizeof(line), "%-12s %10llu %12.3f %12.1f %12.1f %10llu",
+            phase_names[i],
+            static_cast<unsigned long long>(get(c.calls)),
+            get(c.ns) / 1e6,
+            get(c.read) / 1024.0,
+            get(c.written) / 1024.0,
+            static_cast<unsigned long long>(get(c.allocs)));
+        out << line << std::endl;
+    }
+
+    std::snprintf(line, sizeof(line),
+        "Elapsed %.3f ms, read %.1f KB, wrote %.1f KB, %.0f lumps read/s, %.0f lumps written/s",
+        elapsed / 1e6, read / 1024.0, written / 1024.0,
+        per_second(get(reads.calls), get(reads.ns)), per_second(get(writes.calls), get(writes.ns)));
+    out << line << std::endl;
+}
+
+};
+
+#else
+
+namespace Stats {
+
+void print(std::ostream &out, Format format) {
+    if (format != Format::None)
+        out << "Stats were not compiled in (WADTOOLS_STATS)" << std::endl;
+}
+
+};
+
+#endif
+
+namespace Stats {
+
+bool parse_arg(const std::string &arg, Format &format) {
+    if (arg == "--stats")
+        format = Format::Text;
+    else if (arg == "--stats-json")
+        format = Format::Json;
+    else
+        return false;
+
+#ifdef WADTOOLS_STATS
+    active = true;
+#endif
+
+    return true;
+}
+
+void usage(std::ostream &out) {
+    out << "  --stats       Print per-phase timings, bytes and allocations to stderr once done" << std::endl;
+    out << "  --stats-json  Same as --stats, as a single line of JSON" << std::endl;
+}
+
+};
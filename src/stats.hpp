@@ -0,0 +1,120 @@
+// Copyright (C) 2022 Zach Collins <zcollins4@proton.me>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#ifdef WADTOOLS_STATS
+#include <chrono>
+#endif
+
+namespace Stats {
+
+enum Phase {
+    Other,      // Anything outside of the phases below
+    Open,
+    CreateDirs,
+    ReadLump,
+    WriteLump,
+    Flush,      // Writing out the WAD directory
+    SaveImage,
+    LoadImage,
+    Pk3Read,
+    Pk3Write,
+    Deflate,
+    PhaseCount
+};
+
+enum Format {
+    None,
+    Text,
+    Json
+};
+
+#ifdef WADTOOLS_STATS
+
+constexpr bool enabled = true;
+
+// Off until a tool asks for stats (parse_arg), so that the counters and clocks cost nothing otherwise
+// (Only set before any threads are started)
+extern bool active;
+
+// Bytes and allocations go to the innermost phase on the calling thread
+void add_read(std::uint64_t bytes);
+void add_written(std::uint64_t bytes);
+void add_alloc(std::uint64_t bytes);
+
+Phase enter(Phase phase);
+void leave(Phase phase, Phase previous, std::uint64_t ns);
+
+// Times a phase for as long as it is in scope, including any phases nested in it
+class Timer
+{
+public:
+    explicit Timer(Phase phase) : active_(active), phase_(phase), previous_(Other) {
+        if (!active_)
+            return;
+
+        previous_ = enter(phase);
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    ~Timer() {
+        if (!active_)
+            return;
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        leave(phase_, previous_, ns.count());
+    }
+
+    Timer(const Timer &) = delete;
+    Timer &operator = (const Timer &) = delete;
+
+private:
+    bool active_;
+    Phase phase_, previous_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#else
+
+constexpr bool enabled = false;
+constexpr bool active = false;
+
+inline void add_read(std::uint64_t) {}
+inline void add_written(std::uint64_t) {}
+inline void add_alloc(std::uint64_t) {}
+
+class Timer
+{
+public:
+    explicit Timer(Phase) {
+    }
+};
+
+#endif
+
+void print(std::ostream &out, Format format);
+
+// Shared by the tools, returns false if the argument isn't a stats option (Turns the stats on if it is)
+bool parse_arg(const std::string &arg, Format &format);
+
+// The options line for a tool's usage text
+void usage(std::ostream &out);
+
+};
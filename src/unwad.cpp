@@ -16,7 +16,9 @@
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <vector>
 #include "wadfile.hpp"
+#include "stats.hpp"
 
 void process_dir(const std::string &base_path, WadFile &wad, std::size_t dir_index) {
     auto dir = wad.get_dir(dir_index);
@@ -39,6 +41,8 @@ void process_dir(const std::string &base_path, WadFile &wad, std::size_t dir_ind
 
         lump->write(file);
         file.close();
+
+        Stats::add_written(lump->size());
     }
 
     // Do the other directories
@@ -47,13 +51,23 @@ void process_dir(const std::string &base_path, WadFile &wad, std::size_t dir_ind
 }
 
 int main(int argc, char **argv) {
-    if (argc < 2) {
-        std::cout << "Usage: " << argv[0] << " [WAD PATHS...]" << std::endl;
+    Stats::Format stats = Stats::None;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (!Stats::parse_arg(arg, stats))
+            paths.push_back(arg);
+    }
+
+    if (paths.empty()) {
+        std::cout << "Usage: " << argv[0] << " [--stats | --stats-json] [WAD PATHS...]" << std::endl;
+        Stats::usage(std::cout);
         return 1;
     }
 
-    for (int i = 1; i < argc; i++) {
-        std::string path = argv[i];
+    for (const auto &path : paths) {
         std::cout << "Extracting " << path << "..." << std::endl;
 
         try {
@@ -67,9 +81,12 @@ int main(int argc, char **argv) {
         }
         catch (const std::exception &ex) {
             std::cerr << "Error: " << ex.what() << std::endl;
+            Stats::print(std::cerr, stats);
             return 1;
         }
     }
 
+    Stats::print(std::cerr, stats);
+
     return 0;
 }
@@ -15,78 +15,74 @@
 
 #include "wadfile.hpp"
 #include "common.hpp"
+#include "stats.hpp"
 #include <algorithm>
 #include <cassert>
-#include <cstring>
+#include <fstream>
+#include <sstream>
 
 WadFile::WadFile(const std::string &path, Mode mode) : mode_(mode) {
     // Default directory
     dirs.push_back({"", {}, {}});
 
-    if (mode == Mode::Open)
-        open(path);
-    else
-        create(path);
+    auto file_buf = std::make_unique<std::filebuf>();
+
+    if (mode == Mode::Open) {
+        if (!file_buf->open(path, std::ios::in | std::ios::binary))
+            throw std::runtime_error("Unable to open file " + path);
+
+        attach(std::move(file_buf));
+        open("File " + path);
+    }
+    else {
+        if (!file_buf->open(path, std::ios::out | std::ios::binary))
+            throw std::runtime_error("Unable to create file " + path);
+
+        attach(std::move(file_buf));
+        create();
+    }
 }
 
-WadFile::~WadFile() {
-    // Only for saving
-    if (mode_ == Mode::Open)
-        return;
+WadFile::WadFile(const Lump &lump, const std::string &name) : mode_(Mode::Open), memory_(true) {
+    dirs.push_back({"", {}, {}});
 
-    // Create the lumps
-    std::vector<LumpEntry> lumps;
-    for (const auto &dir : dirs) {
-        LumpEntry marker;
-        marker.offset = marker.size = 0;
-        std::copy(dir.name.begin(), dir.name.end(), marker.name);
+    std::string data(reinterpret_cast<const char*>(lump.data()), lump.size());
+    attach(std::make_unique<std::stringbuf>(std::move(data), std::ios::in | std::ios::binary));
+    open(name);
+}
 
-        if (is_map_lump(marker.name)) {
-            lumps.push_back(marker);
+WadFile::WadFile(Mode mode) : mode_(mode), memory_(true) {
+    assert(mode != Mode::Open);
 
-            for (const auto &lump : dir.lumps)
-                lumps.push_back(this->lumps[lump]);
-        }
+    dirs.push_back({"", {}, {}});
 
-        else if (dir.name.size()) {
-            // Start marker
-            std::copy_n("_START", 6, marker.name+dir.name.size());
-            lumps.push_back(marker);
+    attach(std::make_unique<std::stringbuf>(std::ios::in | std::ios::out | std::ios::binary));
+    create();
+}
 
-            for (const auto &lump : dir.lumps)
-                lumps.push_back(this->lumps[lump]);
+WadFile::~WadFile() {
+    // Only for saving
+    if (mode_ == Mode::Open || saved_)
+        return;
 
-            // End marker
-            std::copy_n("_END", 4, marker.name+dir.name.size());
-            lumps.push_back(marker);
-        }
+    flush();
+}
 
-        else {
-            for (const auto &lump : dir.lumps)
-                lumps.push_back(this->lumps[lump]);
-        }
-    }
+Lump WadFile::save() {
+    if (mode_ == Mode::Open || saved_)
+        return Lump();
 
-    // Create the header
-    Header header;
-    header.id[0] = (mode_ == Mode::CreateIWAD) ? 'I' : 'P';
-    header.id[1] = 'W'; header.id[2] = 'A'; header.id[3] = 'D';
-    header.size   = Common::little32(lumps.size());
-    header.offset = Common::little32(file.tellp());
+    flush();
+    saved_ = true;
 
-    // Save the lump entries
-    for (auto lump : lumps) {
-        // Endian swap the lump entry
-        lump.offset = Common::little32(lump.offset);
-        lump.size   = Common::little32(lump.size);
+    if (!memory_)
+        return Lump();
 
-        file.write(reinterpret_cast<char*>(&lump), sizeof(LumpEntry));
-    }
+    auto data = static_cast<std::stringbuf*>(buf.get())->str();
+    auto copy = std::make_unique<std::uint8_t[]>(data.size());
+    std::copy(data.begin(), data.end(), copy.get());
 
-    // Now save the header
-    file.seekg(0, std::ios::beg);
-    file.write(reinterpret_cast<char*>(&header), sizeof(Header));
-    file.close();
+    return Lump(std::move(copy), data.size());
 }
 
 const WadFile::Dir &WadFile::root_dir() const {
@@ -105,8 +101,8 @@ std::size_t WadFile::create_dir(std::size_t parent, const std::string &name) {
     if (mode_ == Mode::Open)
         return 0;
 
-    // Make sure that the name is not too long
-    if (name.size() > 2)
+    // Make sure that the name is not too long (Map markers have no "_START" suffix)
+    if (name.size() > (LumpNames::is_map_marker(LumpNames::pack(name.c_str())) ? 8 : 2))
         return 0;
 
     // Create the directory
@@ -116,6 +112,13 @@ std::size_t WadFile::create_dir(std::size_t parent, const std::string &name) {
     return dirs.size() - 1;
 }
 
+bool WadFile::is_map(std::size_t dir) const {
+    assert(dir < dirs.size());
+
+    const auto &name = dirs[dir].name;
+    return name.size() <= 8 && LumpNames::is_map_marker(LumpNames::pack(name.c_str()));
+}
+
 std::string WadFile::lump_name(std::size_t index) const {
     assert(index < lumps.size());
 
@@ -128,6 +131,15 @@ std::size_t WadFile::lump_size(std::size_t index) const {
     return lumps[index].size;
 }
 
+LumpType WadFile::lump_type(std::size_t index) const {
+    assert(index < lumps.size());
+
+    if (mode_ != Mode::Open)
+        return LumpType::Raw;
+
+    return types[index];
+}
+
 bool WadFile::valid() {
     if (mode_ != Mode::Open)
         return false;
@@ -148,23 +160,24 @@ std::unique_ptr<Lump> WadFile::read_lump(std::size_t dir, std::size_t index) {
     assert(dir < dirs.size());
     assert(index < lumps.size());
 
+    Stats::Timer timer(Stats::ReadLump);
+
     if (mode_ != Mode::Open)
         return std::make_unique<Lump>();
 
     file.seekg(lumps[index].offset, std::ios::beg);
-    auto name = lump_name(lumps[index].name);
+    add_read(lumps[index].size);
 
-    if (name == "PLAYPAL")
-        return std::make_unique<Palette>(file, lumps[index].size);
-
-    return std::make_unique<Lump>(file, lumps[index].size);
+    return Registry::read(types[index], file, lumps[index].size);
 }
 
 bool WadFile::write_lump(const std::size_t dir, const std::string &name, Lump lump) {
     assert(dir < dirs.size());
 
-    // Including null-terminator
-    if (mode_ == Mode::Open || name.size() >= sizeof(LumpEntry::name))
+    Stats::Timer timer(Stats::WriteLump);
+
+    // Names only need a null-terminator when they are shorter than 8 characters
+    if (mode_ == Mode::Open || name.size() > sizeof(LumpEntry::name))
         return false;
 
     // Create the entry
@@ -182,22 +195,26 @@ bool WadFile::write_lump(const std::size_t dir, const std::string &name, Lump lu
 
     // Write the data
     lump.write(file);
+    add_written(entry.size);
 
     return true;
 }
 
-void WadFile::open(const std::string &path) {
-    // Read the header
-    file = std::fstream(path, std::ios::in | std::ios::binary);
-    if (!file.good())
-        throw std::runtime_error("Unable to open file " + path);
+void WadFile::attach(std::unique_ptr<std::streambuf> buf) {
+    this->buf = std::move(buf);
+    file.rdbuf(this->buf.get());
+}
 
+void WadFile::open(const std::string &name) {
+    Stats::Timer timer(Stats::Open);
+
+    // Read the header
     Header header;
     file.read(reinterpret_cast<char*>(&header), sizeof(Header));
 
     // Make sure that the file is a WAD
     if (std::string(header.id, 4) != "IWAD" && std::string(header.id, 4) != "PWAD")
-        throw std::runtime_error("File " + path + " is not a WAD");
+        throw std::runtime_error(name + " is not a WAD");
 
     header.offset = Common::little32(header.offset);
     header.size   = Common::little32(header.size);
@@ -213,29 +230,79 @@ void WadFile::open(const std::string &path) {
         lump.size   = Common::little32(lump.size);
     }
 
+    names.resize(lumps.size());
+    for (std::size_t i = 0; i < lumps.size(); i++)
+        names[i] = LumpNames::pack_entry(lumps[i].name);
+
+    add_read(sizeof(Header) + lumps.size() * sizeof(LumpEntry));
+
     // Create the directories
-    create_dirs(0, 0, lumps.size()-1);
+    if (lumps.size()) {
+        Stats::Timer timer(Stats::CreateDirs);
+        create_dirs(0, 0, lumps.size()-1);
+    }
+
+    // Work out the type of every lump
+    types.resize(lumps.size(), LumpType::Raw);
+    classify_dir(0, LumpType::Raw);
 
     // Load the palette
-    for (const auto &lump : lumps) {
-        if (lump.name[0] == 'P') {
-            if (lump_name(lump.name) == "PLAYPAL" && (lump.size % 768) == 0) {
-                file.seekg(lump.offset, std::ios::beg);
-                pal = std::make_unique<Palette>(file, lump.size);
-                break;
-            }
+    for (std::size_t i = 0; i < lumps.size(); i++) {
+        if (types[i] == LumpType::Palette && (lumps[i].size % 768) == 0) {
+            file.seekg(lumps[i].offset, std::ios::beg);
+            pal = std::make_unique<Palette>(file, lumps[i].size);
+            add_read(lumps[i].size);
+            break;
         }
     }
 }
 
-void WadFile::create(const std::string &path) {
-    // Create the file
-    file = std::fstream(path, std::ios::out | std::ios::binary);
-    if (!file.good())
-        throw std::runtime_error("Unable to create file " + path);
+void WadFile::create() {
+    // Leave space for the header (We'll fill it in later)
+    Header header = {};
+    file.write(reinterpret_cast<char*>(&header), sizeof(Header));
+}
+
+void WadFile::flush() {
+    Stats::Timer timer(Stats::Flush);
+
+    // Create the lumps
+    std::vector<LumpEntry> lumps;
+    write_dir(0, lumps);
+
+    // Create the header
+    Header header;
+    header.id[0] = (mode_ == Mode::CreateIWAD) ? 'I' : 'P';
+    header.id[1] = 'W'; header.id[2] = 'A'; header.id[3] = 'D';
+    header.size   = Common::little32(lumps.size());
+    header.offset = Common::little32(file.tellp());
 
-    // Skip the space where the header goes (We'll fill it in later)
-    file.seekg(sizeof(Header), std::ios::beg);
+    // Save the lump entries
+    for (auto lump : lumps) {
+        // Endian swap the lump entry
+        lump.offset = Common::little32(lump.offset);
+        lump.size   = Common::little32(lump.size);
+
+        file.write(reinterpret_cast<char*>(&lump), sizeof(LumpEntry));
+    }
+
+    // Now save the header
+    file.seekp(0, std::ios::beg);
+    file.write(reinterpret_cast<char*>(&header), sizeof(Header));
+    file.flush();
+
+    add_written(sizeof(Header) + lumps.size() * sizeof(LumpEntry));
+}
+
+// Only file traffic counts, the stats are for diagnosing slow storage
+void WadFile::add_read(std::uint64_t bytes) const {
+    if (!memory_)
+        Stats::add_read(bytes);
+}
+
+void WadFile::add_written(std::uint64_t bytes) const {
+    if (!memory_)
+        Stats::add_written(bytes);
 }
 
 void WadFile::create_dirs(std::size_t cur, std::size_t offset, std::size_t end) {
@@ -248,45 +315,52 @@ void WadFile::create_dirs(std::size_t cur, std::size_t offset, std::size_t end)
         }
 
         // Check if this is a map marker
-        auto name = lump_name(lumps[i].name);
-        if (is_map_marker(lumps[i].name)) {
+        if (LumpNames::is_map_marker(names[i])) {
             // Find the end of the lumps
-            int j;
-            for (j = i+1; j < std::min<int>(i+11, end); j++) {
-                if (!is_map_lump(lumps[j].name))
-                    break;
+            std::size_t j = i+1;
+
+            if (j <= end && Registry::table.find(names[j]) == LumpType::TextMap) {
+                // UDMF, everything up to and including ENDMAP
+                auto k = j;
+                while (k <= end && Registry::table.find(names[k]) != LumpType::EndMap)
+                    k++;
+
+                j = (k <= end) ? k+1 : j;
+            }
+            else {
+                for (; j < std::min<std::size_t>(i+1 + Registry::map_lump_count, end+1); j++) {
+                    if (!Registry::is_map_lump(names[j]))
+                        break;
+                }
             }
 
             // Create the directory
             dirs[cur].dirs.push_back(dirs.size());
-            dirs.push_back({name, {}, {}});
+            dirs.push_back({lump_name(lumps[i].name), {}, {}});
 
             // Add the lumps to the directory
-            for (int k = i+1; k < j; k++)
+            for (auto k = i+1; k < j; k++)
                 dirs.back().lumps.push_back(k);
 
-            i += j - i;
+            // Continue with the first lump after the map
+            i = j - 1;
 
             continue;
         }
 
         // Make sure that this is a starting marker
-        if (!Common::ends_with(name, "_START")) {
+        auto prefix = LumpNames::start_marker(names[i]);
+        if (!prefix) {
             dirs[cur].lumps.push_back(i);
             continue;
         }
 
-        // Strip the "_START" from the name
-        name = name.substr(0, name.size() - 6);
-
         // Search for the end marker
-        int j;
-        for (j = i+1; j < lumps.size(); j++) {
-            if (lumps[j].size)
-                continue;
+        auto end_marker = LumpNames::end_marker(prefix);
 
-            // Check if this is the end marker
-            if (lump_name(lumps[j].name) == (name+"_END"))
+        std::size_t j;
+        for (j = i+1; j < lumps.size(); j++) {
+            if (!lumps[j].size && names[j] == end_marker)
                 break;
         }
 
@@ -296,9 +370,9 @@ void WadFile::create_dirs(std::size_t cur, std::size_t offset, std::size_t end)
             continue;
         }
 
-        // Create the directory
+        // Create the directory (Without the "_START")
         dirs[cur].dirs.push_back(dirs.size());
-        dirs.push_back({name, {}, {}});
+        dirs.push_back({lump_name(lumps[i].name).substr(0, LumpNames::length(prefix)), {}, {}});
 
         // Recursively add the lumps to the directory
         create_dirs(dirs.size()-1, i+1, j-1);
@@ -306,6 +380,52 @@ void WadFile::create_dirs(std::size_t cur, std::size_t offset, std::size_t end)
     }
 }
 
+void WadFile::classify_dir(std::size_t index, LumpType ns) {
+    // Sub-namespaces (e.g. F1 inside of F) keep the type of their parent
+    auto dir_type = Registry::namespace_type(LumpNames::pack(dirs[index].name.c_str()));
+    ns = (dir_type == LumpType::Raw) ? ns : dir_type;
+
+    for (auto i : dirs[index].lumps)
+        types[i] = Registry::classify(names[i], ns);
+
+    for (auto i : dirs[index].dirs)
+        classify_dir(i, ns);
+}
+
+void WadFile::write_dir(std::size_t index, std::vector<LumpEntry> &entries) const {
+    const auto &dir = dirs[index];
+
+    LumpEntry marker;
+    marker.offset = marker.size = 0;
+    std::fill_n(marker.name, sizeof(marker.name), 0x00);
+    std::copy(dir.name.begin(), dir.name.end(), marker.name);
+
+    bool is_map = LumpNames::is_map_marker(LumpNames::pack_entry(marker.name));
+
+    // Start marker
+    if (is_map) {
+        entries.push_back(marker);
+    }
+    else if (dir.name.size()) {
+        std::copy_n("_START", 6, marker.name+dir.name.size());
+        entries.push_back(marker);
+    }
+
+    for (const auto &lump : dir.lumps)
+        entries.push_back(lumps[lump]);
+
+    // Sub-directories go inside of their parent's markers
+    for (const auto &sub : dir.dirs)
+        write_dir(sub, entries);
+
+    // End marker (Clearing out what is left of "_START")
+    if (!is_map && dir.name.size()) {
+        std::fill_n(marker.name+dir.name.size(), sizeof(marker.name)-dir.name.size(), 0x00);
+        std::copy_n("_END", 4, marker.name+dir.name.size());
+        entries.push_back(marker);
+    }
+}
+
 std::string WadFile::lump_name(const char name[8]) const {
     // Find first occurence of a null byte
     int i;
@@ -319,39 +439,3 @@ std::string WadFile::lump_name(const char name[8]) const {
 
     return std::string(name, 8);
 }
-
-bool WadFile::is_map_marker(const char name[8]) const {
-    if (name[0] == 'E' && name[2] == 'M') {
-        if (!std::isdigit(name[1])) return false;
-        if (!std::isdigit(name[3])) return false;
-        if (name[4]) return false;
-
-        return true;
-    }
-
-    else if (name[0] == 'M' && name[1] == 'A' && name[3] == 'P') {
-        if (!std::isdigit(name[3])) return false;
-        if (!std::isdigit(name[4])) return false;
-        if (name[5]) return false;
-
-        return true;
-    }
-
-    return false;
-}
-
-bool WadFile::is_map_lump(const char name[8]) const {
-    if (strncmp(name, "THINGS",   8) == 0 ||
-        strncmp(name, "LINEDEFS", 8) == 0 ||
-        strncmp(name, "SIDEDEFS", 8) == 0 ||
-        strncmp(name, "VERTEXES", 8) == 0 ||
-        strncmp(name, "SEGS",     8) == 0 ||
-        strncmp(name, "SSECTORS", 8) == 0 ||
-        strncmp(name, "NODES",    8) == 0 ||
-        strncmp(name, "SECTORS",  8) == 0 ||
-        strncmp(name, "REJECT",   8) == 0 ||
-        strncmp(name, "BLOCKMAP", 8) == 0)
-        return true;
-
-    return false;
-}
@@ -18,10 +18,11 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <fstream>
+#include <istream>
 
 #include "lump.hpp"
 #include "palette.hpp"
+#include "registry.hpp"
 
 class WadFile
 {
@@ -38,14 +39,21 @@ public:
     };
 
     WadFile(const std::string &path, Mode mode);
+    WadFile(const Lump &lump, const std::string &name); // Open a WAD held in memory
+    WadFile(Mode mode);                                 // Create a WAD in memory
     ~WadFile();
 
+    // Writes out the directory, and returns the data for WADs created in memory
+    Lump save();
+
     const Dir &root_dir() const;
     const Dir &get_dir(std::size_t index) const;
     std::size_t create_dir(std::size_t parent, const std::string &name);
+    bool is_map(std::size_t dir) const;
 
     std::string lump_name(std::size_t index) const;
     std::size_t lump_size(std::size_t index) const;
+    LumpType lump_type(std::size_t index) const;
 
     bool valid();
 
@@ -65,19 +73,29 @@ private:
         char name[8];
     };
 
-    void open(const std::string &path);
-    void create(const std::string &path);
+    void attach(std::unique_ptr<std::streambuf> buf);
+    void open(const std::string &name);
+    void create();
+    void flush();
     void create_dirs(std::size_t cur, std::size_t offset, std::size_t end);
+    void classify_dir(std::size_t index, LumpType ns);
+    void write_dir(std::size_t index, std::vector<LumpEntry> &entries) const;
 
     std::string lump_name(const char name[8]) const;
-    bool is_map_marker(const char name[8]) const;
-    bool is_map_lump(const char name[8]) const;
+
+    void add_read(std::uint64_t bytes) const;
+    void add_written(std::uint64_t bytes) const;
 
     Mode mode_;
+    bool memory_ = false;
+    bool saved_ = false;
 
     std::vector<Dir> dirs;
     std::vector<LumpEntry> lumps;
-    std::fstream file;
+    std::vector<std::uint64_t> names; // Packed lump names (Only when opened)
+    std::vector<LumpType> types;
+    std::unique_ptr<std::streambuf> buf;
+    std::iostream file{nullptr};
 
     std::unique_ptr<Palette> pal;
 };